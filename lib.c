@@ -56,9 +56,23 @@ static const struct lang_table escape_tables[] = {
 
 #define GSM_ESCAPE_CHAR 0x1b
 
-static void save_char(uint8_t gsmchar, const struct lang_table *single,
-                      const struct lang_table *locking, uint16_t *output,
-                      size_t outsiz, int *in_escape, size_t *output_chars) {
+typedef void (*store_char_fn)(void *output, size_t idx, uint16_t unichar);
+
+static void store_host(void *output, size_t idx, uint16_t unichar) {
+  ((uint16_t *)output)[idx] = unichar;
+}
+
+static void store_ucs2be(void *output, size_t idx, uint16_t unichar) {
+  uint8_t *const out = output;
+  out[2 * idx] = (unichar >> 8);
+  out[(2 * idx) + 1] = (unichar & 0xff);
+}
+
+static inline void save_char(uint8_t gsmchar,
+                             const struct lang_table *single,
+                             const struct lang_table *locking, void *output,
+                             size_t outsiz, store_char_fn store,
+                             int *in_escape, size_t *output_chars) {
   uint16_t unichar = 0;
   if (gsmchar == GSM_ESCAPE_CHAR) {
     *in_escape = 1;
@@ -71,16 +85,17 @@ static void save_char(uint8_t gsmchar, const struct lang_table *single,
 
   if (!*in_escape) {
     if (*output_chars < outsiz) {
-      output[*output_chars] = (unichar != 0) ? unichar : ' ';
+      store(output, *output_chars, (unichar != 0) ? unichar : ' ');
     }
     *output_chars += 1;
   }
 }
 
-size_t gpp23038_7bit_to_unicode(const uint8_t *packed, size_t num_octets,
-                                uint16_t *output, size_t outsiz,
-                                enum gpp23038_shift_table single_shift,
-                                enum gpp23038_shift_table locking_shift) {
+static inline size_t decode_7bit(const uint8_t *packed, size_t num_octets,
+                                 void *output, size_t outsiz,
+                                 store_char_fn store,
+                                 enum gpp23038_shift_table single_shift,
+                                 enum gpp23038_shift_table locking_shift) {
   const struct lang_table *const single = &escape_tables[single_shift];
   const struct lang_table *const locking = &full_tables[locking_shift];
 
@@ -95,7 +110,7 @@ size_t gpp23038_7bit_to_unicode(const uint8_t *packed, size_t num_octets,
       shiftreg >>= 7;
       valid_bits -= 7;
 
-      save_char(gsmchar, single, locking, output, outsiz, &in_escape,
+      save_char(gsmchar, single, locking, output, outsiz, store, &in_escape,
                 &output_chars);
     }
     shiftreg |= ((packed[i]) << valid_bits);
@@ -104,12 +119,12 @@ size_t gpp23038_7bit_to_unicode(const uint8_t *packed, size_t num_octets,
 
   if (valid_bits >= 7) {
     uint8_t gsmchar = (shiftreg & 0x7f);
-    save_char(gsmchar, single, locking, output, outsiz, &in_escape,
+    save_char(gsmchar, single, locking, output, outsiz, store, &in_escape,
               &output_chars);
 
     if (in_escape) {
       if (output_chars < outsiz) {
-        output[output_chars] = ' ';
+        store(output, output_chars, ' ');
       }
       ++output_chars;
     }
@@ -118,10 +133,11 @@ size_t gpp23038_7bit_to_unicode(const uint8_t *packed, size_t num_octets,
   return output_chars;
 }
 
-size_t gpp23038_8bit_to_unicode(const uint8_t *unpacked, size_t num_octets,
-                                uint16_t *output, size_t outsiz,
-                                enum gpp23038_shift_table single_shift,
-                                enum gpp23038_shift_table locking_shift) {
+static inline size_t decode_8bit(const uint8_t *unpacked, size_t num_octets,
+                                 void *output, size_t outsiz,
+                                 store_char_fn store,
+                                 enum gpp23038_shift_table single_shift,
+                                 enum gpp23038_shift_table locking_shift) {
   const struct lang_table *const single = &escape_tables[single_shift];
   const struct lang_table *const locking = &full_tables[locking_shift];
 
@@ -130,13 +146,47 @@ size_t gpp23038_8bit_to_unicode(const uint8_t *unpacked, size_t num_octets,
 
   for (unsigned int i = 0; i < num_octets; ++i) {
     uint8_t gsmchar = unpacked[i] & 0x7f;
-    save_char(gsmchar, single, locking, output, outsiz, &in_escape,
+    save_char(gsmchar, single, locking, output, outsiz, store, &in_escape,
               &output_chars);
   }
 
   return output_chars;
 }
 
+size_t gpp23038_7bit_to_unicode(const uint8_t *packed, size_t num_octets,
+                                uint16_t *output, size_t outsiz,
+                                enum gpp23038_shift_table single_shift,
+                                enum gpp23038_shift_table locking_shift) {
+  return decode_7bit(packed, num_octets, output, outsiz, store_host,
+                     single_shift, locking_shift);
+}
+
+size_t gpp23038_8bit_to_unicode(const uint8_t *unpacked, size_t num_octets,
+                                uint16_t *output, size_t outsiz,
+                                enum gpp23038_shift_table single_shift,
+                                enum gpp23038_shift_table locking_shift) {
+  return decode_8bit(unpacked, num_octets, output, outsiz, store_host,
+                     single_shift, locking_shift);
+}
+
+size_t gpp23038_7bit_to_ucs2be(const uint8_t *packed, size_t num_octets,
+                               uint8_t *output, size_t outsiz,
+                               enum gpp23038_shift_table single_shift,
+                               enum gpp23038_shift_table locking_shift) {
+  /* only whole code units are ever written, so an odd trailing octet in the
+   * output buffer is left untouched. */
+  return 2 * decode_7bit(packed, num_octets, output, outsiz / 2, store_ucs2be,
+                         single_shift, locking_shift);
+}
+
+size_t gpp23038_8bit_to_ucs2be(const uint8_t *unpacked, size_t num_octets,
+                               uint8_t *output, size_t outsiz,
+                               enum gpp23038_shift_table single_shift,
+                               enum gpp23038_shift_table locking_shift) {
+  return 2 * decode_8bit(unpacked, num_octets, output, outsiz / 2,
+                         store_ucs2be, single_shift, locking_shift);
+}
+
 static int compare_mappings(const void *a, const void *b) {
   const struct mapping_entry *const entryA = a;
   const struct mapping_entry *const entryB = b;
@@ -177,10 +227,14 @@ static unsigned int rank_get_score(const struct shift_tables_rank *rank) {
   return (1000 * rank->missed_chars) + (100 * udh_bytes) + rank->used_escapes;
 }
 
-static int compare_ranks(const void *a, const void *b) {
-  const struct shift_tables_rank *const rankA = a;
-  const struct shift_tables_rank *const rankB = b;
-  return rank_get_score(rankA) - rank_get_score(rankB);
+static void rank_keep_best(struct shift_tables_rank *best, int *have_best,
+                           const struct shift_tables_rank *candidate) {
+  /* strictly better only, so that ties are always won by the combination which
+   * was looked at first. */
+  if (!*have_best || rank_get_score(candidate) < rank_get_score(best)) {
+    *best = *candidate;
+    *have_best = 1;
+  }
 }
 
 static void rank_tables(struct shift_tables_rank *rank, const uint16_t *input,
@@ -205,20 +259,17 @@ static void rank_tables(struct shift_tables_rank *rank, const uint16_t *input,
 int gpp23038_seek_shift_table(const uint16_t *input, size_t insiz,
                               enum gpp23038_shift_table *single_shift,
                               enum gpp23038_shift_table *locking_shift) {
-  struct shift_tables_rank ranks[GPP23038_TABLE__LAST * GPP23038_TABLE__LAST] =
-      {0};
+  struct shift_tables_rank best_rank = {0};
+  int have_best = 0;
 
   for (enum gpp23038_shift_table locking = GPP23038_TABLE_DEFAULT;
        locking < GPP23038_TABLE__LAST; ++locking) {
     for (enum gpp23038_shift_table single = GPP23038_TABLE_DEFAULT;
          single < GPP23038_TABLE__LAST; ++single) {
+      struct shift_tables_rank rank;
+      rank_tables(&rank, input, insiz, single, locking);
 
-      struct shift_tables_rank *rank =
-          &ranks[(locking * GPP23038_TABLE__LAST) + single];
-
-      rank_tables(rank, input, insiz, single, locking);
-
-      if (rank->missed_chars == 0 && rank->used_escapes == 0 &&
+      if (rank.missed_chars == 0 && rank.used_escapes == 0 &&
           locking == GPP23038_TABLE_DEFAULT &&
           single == GPP23038_TABLE_DEFAULT) {
         /* can't get better than that. */
@@ -226,15 +277,93 @@ int gpp23038_seek_shift_table(const uint16_t *input, size_t insiz,
         *locking_shift = locking;
         return 0;
       }
+
+      rank_keep_best(&best_rank, &have_best, &rank);
     }
   }
 
-  qsort(ranks, ARRAY_SIZE(ranks), sizeof(*ranks), compare_ranks);
-  const struct shift_tables_rank *const best_rank = &ranks[0];
-  *single_shift = best_rank->single;
-  *locking_shift = best_rank->locking;
+  *single_shift = best_rank.single;
+  *locking_shift = best_rank.locking;
 
-  return best_rank->missed_chars != 0;
+  return best_rank.missed_chars != 0;
+}
+
+static void classify_char(uint16_t unichar,
+                          int in_locking[GPP23038_TABLE__LAST],
+                          int in_single[GPP23038_TABLE__LAST]) {
+  for (enum gpp23038_shift_table table = GPP23038_TABLE_DEFAULT;
+       table < GPP23038_TABLE__LAST; ++table) {
+    uint8_t gsmchar;
+    in_locking[table] = seek_mapping(unichar, &gsmchar, &full_tables[table]);
+    in_single[table] = seek_mapping(unichar, &gsmchar, &escape_tables[table]);
+  }
+}
+
+static void selector_update(struct gpp23038_shift_table_selector *selector,
+                            uint16_t unichar, int delta) {
+  int in_locking[GPP23038_TABLE__LAST];
+  int in_single[GPP23038_TABLE__LAST];
+  classify_char(unichar, in_locking, in_single);
+
+  for (enum gpp23038_shift_table locking = GPP23038_TABLE_DEFAULT;
+       locking < GPP23038_TABLE__LAST; ++locking) {
+    if (in_locking[locking]) {
+      continue;
+    }
+    for (enum gpp23038_shift_table single = GPP23038_TABLE_DEFAULT;
+         single < GPP23038_TABLE__LAST; ++single) {
+      if (in_single[single]) {
+        selector->used_escapes[locking][single] += delta;
+      } else {
+        selector->missed_chars[locking][single] += delta;
+      }
+    }
+  }
+  selector->num_chars += delta;
+}
+
+void gpp23038_selector_init(struct gpp23038_shift_table_selector *selector) {
+  memset(selector, 0, sizeof(*selector));
+}
+
+void gpp23038_selector_add(struct gpp23038_shift_table_selector *selector,
+                           uint16_t unichar) {
+  selector_update(selector, unichar, 1);
+}
+
+void gpp23038_selector_remove(struct gpp23038_shift_table_selector *selector,
+                              uint16_t unichar) {
+  selector_update(selector, unichar, -1);
+}
+
+int gpp23038_selector_get_shift_table(
+    const struct gpp23038_shift_table_selector *selector,
+    enum gpp23038_shift_table *single_shift,
+    enum gpp23038_shift_table *locking_shift, size_t *num_septets) {
+  struct shift_tables_rank best_rank = {0};
+  int have_best = 0;
+
+  /* walk the combinations in the same order as gpp23038_seek_shift_table, so
+   * that both pick the same one. */
+  for (enum gpp23038_shift_table locking = GPP23038_TABLE_DEFAULT;
+       locking < GPP23038_TABLE__LAST; ++locking) {
+    for (enum gpp23038_shift_table single = GPP23038_TABLE_DEFAULT;
+         single < GPP23038_TABLE__LAST; ++single) {
+      struct shift_tables_rank rank;
+      rank.locking = locking;
+      rank.single = single;
+      rank.missed_chars = selector->missed_chars[locking][single];
+      rank.used_escapes = selector->used_escapes[locking][single];
+
+      rank_keep_best(&best_rank, &have_best, &rank);
+    }
+  }
+
+  *single_shift = best_rank.single;
+  *locking_shift = best_rank.locking;
+  *num_septets = selector->num_chars + best_rank.used_escapes;
+
+  return best_rank.missed_chars != 0;
 }
 
 #define GSM_SPACE_CHAR 0x20
@@ -283,3 +412,16 @@ size_t unicode_to_gpp23038_7bit(const uint16_t *input, size_t insiz,
 
   return out_idx;
 }
+
+size_t unicode_to_gpp23038_ucs2be(const uint16_t *restrict input, size_t insiz,
+                                  uint8_t *restrict output, size_t outsiz) {
+  /* kept as a plain loop over whole code units so that the compiler can turn
+   * it into a vectorised byte swap when optimising for speed (e.g. -O3). */
+  const size_t fits = (insiz < (outsiz / 2)) ? insiz : (outsiz / 2);
+  for (size_t i = 0; i < fits; ++i) {
+    output[2 * i] = (input[i] >> 8);
+    output[(2 * i) + 1] = (input[i] & 0xff);
+  }
+
+  return 2 * insiz;
+}
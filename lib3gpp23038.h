@@ -75,6 +75,31 @@ size_t gpp23038_8bit_to_unicode(const uint8_t *unpacked, size_t num_octets,
                                 enum gpp23038_shift_table single_shift,
                                 enum gpp23038_shift_table locking_shift);
 
+/**
+ * @brief Does the same as @link gpp23038_7bit_to_unicode @endlink , but writes
+ * the decoded code points as a big-endian UCS-2 byte stream, ready to be put
+ * on the wire as-is.
+ * @param outsiz The size of @p output in octets. Only whole code units are
+ * written, so if this is odd the last octet of @p output is left untouched.
+ * @return The number of octets needed to hold the entire result, i.e. twice the
+ * number of processed characters. If this number is greater than @p outsiz ,
+ * then the message in @p output is truncated.
+ */
+size_t gpp23038_7bit_to_ucs2be(const uint8_t *packed, size_t num_octets,
+                               uint8_t *output, size_t outsiz,
+                               enum gpp23038_shift_table single_shift,
+                               enum gpp23038_shift_table locking_shift);
+
+/**
+ * @brief Does the same as @link gpp23038_7bit_to_ucs2be @endlink , but works
+ * on unpacked 7-bit GSM characters, like @link gpp23038_8bit_to_unicode
+ * @endlink .
+ */
+size_t gpp23038_8bit_to_ucs2be(const uint8_t *unpacked, size_t num_octets,
+                               uint8_t *output, size_t outsiz,
+                               enum gpp23038_shift_table single_shift,
+                               enum gpp23038_shift_table locking_shift);
+
 /**
  * @brief Tries to locate the "best" shift tables combination to encode the
  * given input. "Best" is defined as "one that can encode all characters and
@@ -97,6 +122,60 @@ int gpp23038_seek_shift_table(const uint16_t *input, size_t insiz,
                               enum gpp23038_shift_table *single_shift,
                               enum gpp23038_shift_table *locking_shift);
 
+/**
+ * @brief Keeps track of how well each combination of single/locking shift
+ * tables covers a sequence of code points which is being edited, so that the
+ * "best" combination can be picked without inspecting the whole sequence again.
+ * @note Treat the contents as opaque, and only manipulate them by means of the
+ * gpp23038_selector_* functions.
+ */
+struct gpp23038_shift_table_selector {
+  unsigned int num_chars;
+  unsigned int missed_chars[GPP23038_TABLE__LAST][GPP23038_TABLE__LAST];
+  unsigned int used_escapes[GPP23038_TABLE__LAST][GPP23038_TABLE__LAST];
+};
+
+/**
+ * @brief Initialises @p selector to represent an empty sequence of code points.
+ */
+void gpp23038_selector_init(struct gpp23038_shift_table_selector *selector);
+
+/**
+ * @brief Accounts for @p unichar being added to the sequence tracked by
+ * @p selector . The position of the code point within the sequence does not
+ * matter.
+ */
+void gpp23038_selector_add(struct gpp23038_shift_table_selector *selector,
+                           uint16_t unichar);
+
+/**
+ * @brief Accounts for @p unichar being removed from the sequence tracked by
+ * @p selector .
+ * @warning @p unichar must have been previously added to @p selector ,
+ * otherwise the state of @p selector becomes undefined.
+ */
+void gpp23038_selector_remove(struct gpp23038_shift_table_selector *selector,
+                              uint16_t unichar);
+
+/**
+ * @brief Does the same as @link gpp23038_seek_shift_table @endlink for the
+ * sequence of code points tracked by @p selector .
+ * @param selector The selector to inspect.
+ * @param single_shift Pointer to a variable where the single shift language
+ * table will be written.
+ * @param locking_shift Pointer to a variable where the locking shift language
+ * table will be written.
+ * @param num_septets Pointer to a variable where the number of septets needed
+ * to encode the sequence with the chosen tables will be written. This includes
+ * the escape characters, but not the UDH.
+ * @return Zero if the sequence can be encoded losslessly with the shift tables
+ * written into @p single_shift and @p locking_shift , nonzero otherwise.
+ */
+int gpp23038_selector_get_shift_table(
+    const struct gpp23038_shift_table_selector *selector,
+    enum gpp23038_shift_table *single_shift,
+    enum gpp23038_shift_table *locking_shift, size_t *num_septets);
+
 /**
  * @brief Encodes a sequence of Unicode code points into a 7-bit GSM character
  * bitstream, using the given combination of single/locking shift tables.
@@ -114,4 +193,24 @@ size_t unicode_to_gpp23038_7bit(const uint16_t *input, size_t insiz,
                                 enum gpp23038_shift_table single_shift,
                                 enum gpp23038_shift_table locking_shift);
 
+/**
+ * @brief Encodes a sequence of Unicode code points into a big-endian UCS-2
+ * byte stream. This is meant for the case when @link gpp23038_seek_shift_table
+ * @endlink fails to find a suitable combination of shift tables.
+ * @param input Pointer to a sequence of Unicode code points to encode.
+ * @param insiz Number of code points in @p input .
+ * @param output Where to write the output byte stream into.
+ * @param outsiz Number of octets in @p output . Only whole code units are
+ * written, so if this is odd the last octet of @p output is left untouched.
+ * @return The number of octets needed to hold the entire output. If larger than
+ * @p outsiz , the buffer was too small and the byte stream is truncated.
+ * @note The conversion is a simple loop which the compiler may turn into a
+ * vectorised byte swap, but only when optimising for speed (e.g. -O3). The
+ * supplied Makefile passes no optimisation flags, so add them yourself if this
+ * function is on a hot path.
+ * @warning @p input and @p output must not overlap.
+ */
+size_t unicode_to_gpp23038_ucs2be(const uint16_t *input, size_t insiz,
+                                  uint8_t *output, size_t outsiz);
+
 #endif
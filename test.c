@@ -142,6 +142,53 @@ START_TEST(decode_default_gsm_8bit) {
 }
 END_TEST
 
+START_TEST(decode_default_gsm_7bit_ucs2be) {
+  const uint8_t gsm[] = {0xe2, 0x32, 0x5d, 0xbe, 0x3f, 0xd3,
+                         0x41, 0x34, 0xd9, 0xa6, 0x0c};
+  const uint8_t ucs2[] = {0x00, 'b', 0x00, 'e', 0x00, 't', 0x00, 'r',
+                          0x00, 0xe4, 0x00, 'g', 0x00, 't', 0x00, ' ',
+                          0x00, '4', 0x00, '2', 0x20, 0xac};
+  uint8_t buf[sizeof(ucs2)];
+
+  size_t rv =
+      gpp23038_7bit_to_ucs2be(gsm, sizeof(gsm), buf, sizeof(buf),
+                              GPP23038_TABLE_DEFAULT, GPP23038_TABLE_DEFAULT);
+
+  ck_assert_uint_eq(rv, sizeof(ucs2));
+  ck_assert_mem_eq(buf, ucs2, sizeof(ucs2));
+}
+END_TEST
+
+START_TEST(decode_ucs2be_writes_whole_code_units_only) {
+  const uint8_t gsm[] = {0xa2, 0x11, 0x29, 0xb4, 0xd9, 0x03};
+  const uint8_t ucs2[] = {0x0c, 0x9f, 0x0c, 0xa0, 0x0c, 0xaa, 0x00, '!'};
+  uint8_t buf[sizeof(ucs2) + 1];
+  buf[sizeof(ucs2)] = 0x55;
+
+  size_t rv = gpp23038_7bit_to_ucs2be(gsm, sizeof(gsm), buf, sizeof(buf),
+                                      GPP23038_TABLE_PORTUGUESE,
+                                      GPP23038_TABLE_KANNADA);
+
+  /* five characters in the input, but only four fit in the output buffer. */
+  ck_assert_uint_eq(rv, 10);
+  ck_assert_mem_eq(buf, ucs2, sizeof(ucs2));
+  ck_assert_uint_eq(buf[sizeof(ucs2)], 0x55);
+}
+END_TEST
+
+START_TEST(decode_default_gsm_8bit_ucs2be) {
+  const uint8_t gsm_unpacked[] = {0x32, 0x33, 0x00, 0x02};
+  const uint8_t ucs2[] = {0x00, '2', 0x00, '3', 0x00, '@', 0x00, '$'};
+  uint8_t buf[sizeof(ucs2)];
+
+  size_t rv = gpp23038_8bit_to_ucs2be(gsm_unpacked, sizeof(gsm_unpacked), buf,
+                                      sizeof(buf), GPP23038_TABLE_DEFAULT,
+                                      GPP23038_TABLE_DEFAULT);
+  ck_assert_uint_eq(rv, sizeof(ucs2));
+  ck_assert_mem_eq(buf, ucs2, sizeof(ucs2));
+}
+END_TEST
+
 START_TEST(encode_default_gsm_7bit) {
   const uint8_t gsm[] = {0xc8, 0x32, 0x9b, 0xfd, 0x06};
   const uint16_t uni[] = {'H', 'e', 'l', 'l', 'o'};
@@ -204,6 +251,35 @@ START_TEST(encode_returns_real_size_with_smaller_buffer) {
 }
 END_TEST
 
+START_TEST(encode_ucs2be) {
+  const uint16_t uni[] = {0x416, 'N', 0x03a9, 0x0c03, '$', '@'};
+  const uint8_t ucs2[] = {0x04, 0x16, 0x00, 'N', 0x03, 0xa9,
+                          0x0c, 0x03, 0x00, '$', 0x00, '@'};
+  uint8_t buf[sizeof(ucs2)];
+
+  size_t rv =
+      unicode_to_gpp23038_ucs2be(uni, ARRAY_SIZE(uni), buf, sizeof(buf));
+
+  ck_assert_uint_eq(rv, sizeof(ucs2));
+  ck_assert_mem_eq(buf, ucs2, sizeof(ucs2));
+}
+END_TEST
+
+START_TEST(encode_ucs2be_returns_real_size_with_smaller_buffer) {
+  const uint16_t uni[] = {0x416, 'N', 0x03a9, 0x0c03, '$', '@'};
+  const uint8_t ucs2[] = {0x04, 0x16, 0x00, 'N'};
+  uint8_t buf[5];
+  buf[4] = 0x55;
+
+  size_t rv =
+      unicode_to_gpp23038_ucs2be(uni, ARRAY_SIZE(uni), buf, sizeof(buf));
+
+  ck_assert_uint_eq(rv, 12);
+  ck_assert_mem_eq(buf, ucs2, sizeof(ucs2));
+  ck_assert_uint_eq(buf[4], 0x55);
+}
+END_TEST
+
 START_TEST(seek_default) {
   const uint16_t uni[] = {'2', '3', '@', '$'};
   enum gpp23038_shift_table single, locking;
@@ -240,6 +316,110 @@ START_TEST(seek_no_match) {
 }
 END_TEST
 
+START_TEST(selector_default) {
+  const uint16_t uni[] = {'2', '3', '@', 0x20ac};
+  struct gpp23038_shift_table_selector selector;
+  enum gpp23038_shift_table single, locking;
+  size_t septets;
+
+  gpp23038_selector_init(&selector);
+  for (size_t i = 0; i < ARRAY_SIZE(uni); ++i) {
+    gpp23038_selector_add(&selector, uni[i]);
+  }
+  int rv =
+      gpp23038_selector_get_shift_table(&selector, &single, &locking, &septets);
+
+  ck_assert_int_eq(rv, 0);
+  ck_assert_uint_eq(single, GPP23038_TABLE_DEFAULT);
+  ck_assert_uint_eq(locking, GPP23038_TABLE_DEFAULT);
+  /* the euro sign needs an escape. */
+  ck_assert_uint_eq(septets, 5);
+}
+END_TEST
+
+START_TEST(selector_follows_edits) {
+  /* Kannada characters which are only available in the Kannada locking
+   * table, followed by a character from the Portuguese single shift table. */
+  const uint16_t uni[] = {0x0c9f, 0x0ca0, 0x0caa, '!', 0xe3};
+  struct gpp23038_shift_table_selector selector;
+  enum gpp23038_shift_table single, locking;
+  size_t septets;
+
+  gpp23038_selector_init(&selector);
+  for (size_t i = 0; i < ARRAY_SIZE(uni); ++i) {
+    gpp23038_selector_add(&selector, uni[i]);
+  }
+  int rv =
+      gpp23038_selector_get_shift_table(&selector, &single, &locking, &septets);
+
+  ck_assert_int_eq(rv, 0);
+  ck_assert_uint_eq(single, GPP23038_TABLE_PORTUGUESE);
+  ck_assert_uint_eq(locking, GPP23038_TABLE_KANNADA);
+  ck_assert_uint_eq(septets, 6);
+
+  /* deleting the non-default characters should bring us back to the default
+   * tables. */
+  gpp23038_selector_remove(&selector, 0x0c9f);
+  gpp23038_selector_remove(&selector, 0x0ca0);
+  gpp23038_selector_remove(&selector, 0x0caa);
+  gpp23038_selector_remove(&selector, 0xe3);
+  rv =
+      gpp23038_selector_get_shift_table(&selector, &single, &locking, &septets);
+
+  ck_assert_int_eq(rv, 0);
+  ck_assert_uint_eq(single, GPP23038_TABLE_DEFAULT);
+  ck_assert_uint_eq(locking, GPP23038_TABLE_DEFAULT);
+  ck_assert_uint_eq(septets, 1);
+}
+END_TEST
+
+START_TEST(selector_no_match) {
+  const uint16_t uni[] = {0x416, 'N', 0x03a9, 0x0c03, '$', '@'};
+  struct gpp23038_shift_table_selector selector;
+  enum gpp23038_shift_table single, locking;
+  size_t septets;
+
+  gpp23038_selector_init(&selector);
+  for (size_t i = 0; i < ARRAY_SIZE(uni); ++i) {
+    gpp23038_selector_add(&selector, uni[i]);
+  }
+  int rv =
+      gpp23038_selector_get_shift_table(&selector, &single, &locking, &septets);
+
+  ck_assert_int_eq(rv, 1);
+}
+END_TEST
+
+START_TEST(selector_matches_seek) {
+  /* the danda and double danda are available in the single shift tables of
+   * several Indian languages, so several combinations of tables tie for the
+   * best score. the Cyrillic character can't be encoded at all. */
+  const uint16_t uni[] = {'O', 'K', 0x0964, 0x0965, '$', 0x416, '@'};
+  struct gpp23038_shift_table_selector selector;
+  enum gpp23038_shift_table sel_single, sel_locking, seek_single, seek_locking;
+  size_t septets;
+  uint8_t buf[2 * ARRAY_SIZE(uni)];
+
+  gpp23038_selector_init(&selector);
+  for (size_t i = 0; i < ARRAY_SIZE(uni); ++i) {
+    gpp23038_selector_add(&selector, uni[i]);
+
+    int sel_rv = gpp23038_selector_get_shift_table(&selector, &sel_single,
+                                                   &sel_locking, &septets);
+    int seek_rv =
+        gpp23038_seek_shift_table(uni, i + 1, &seek_single, &seek_locking);
+
+    ck_assert_int_eq(sel_rv, seek_rv);
+    ck_assert_uint_eq(sel_single, seek_single);
+    ck_assert_uint_eq(sel_locking, seek_locking);
+
+    size_t octets = unicode_to_gpp23038_7bit(uni, i + 1, buf, sizeof(buf),
+                                             sel_single, sel_locking);
+    ck_assert_uint_eq(octets, ((septets * 7) + 7) / 8);
+  }
+}
+END_TEST
+
 static Suite *gpp23038_suite(void) {
   Suite *s = suite_create("3GPP_23.038");
 
@@ -254,6 +434,9 @@ static Suite *gpp23038_suite(void) {
   tcase_add_test(decode_tc,
                  decode_can_use_different_alphabet_and_escape_tables);
   tcase_add_test(decode_tc, decode_default_gsm_8bit);
+  tcase_add_test(decode_tc, decode_default_gsm_7bit_ucs2be);
+  tcase_add_test(decode_tc, decode_ucs2be_writes_whole_code_units_only);
+  tcase_add_test(decode_tc, decode_default_gsm_8bit_ucs2be);
   suite_add_tcase(s, decode_tc);
 
   TCase *encode_tc = tcase_create("Encode");
@@ -261,6 +444,9 @@ static Suite *gpp23038_suite(void) {
   tcase_add_test(encode_tc, encode_escaped_gsm_7bit);
   tcase_add_test(encode_tc, encode_replaces_unknown_char_with_space);
   tcase_add_test(encode_tc, encode_returns_real_size_with_smaller_buffer);
+  tcase_add_test(encode_tc, encode_ucs2be);
+  tcase_add_test(encode_tc,
+                 encode_ucs2be_returns_real_size_with_smaller_buffer);
   suite_add_tcase(s, encode_tc);
 
   TCase *seek_tc = tcase_create("Seek");
@@ -269,6 +455,13 @@ static Suite *gpp23038_suite(void) {
   tcase_add_test(seek_tc, seek_no_match);
   suite_add_tcase(s, seek_tc);
 
+  TCase *selector_tc = tcase_create("Selector");
+  tcase_add_test(selector_tc, selector_default);
+  tcase_add_test(selector_tc, selector_follows_edits);
+  tcase_add_test(selector_tc, selector_no_match);
+  tcase_add_test(selector_tc, selector_matches_seek);
+  suite_add_tcase(s, selector_tc);
+
   return s;
 }
 